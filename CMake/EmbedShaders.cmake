@@ -0,0 +1,43 @@
+# Turns compiled shader blobs into a C++ header with one constant byte array per
+#  shader, so the executable doesn't depend on its working directory to start.
+#
+# Usage:
+#   cmake -DSHADER_FILES="a.dxil;b.dxil" -DSHADER_NAMES="a;b" -DOUTPUT=EmbeddedShaders.h -P EmbedShaders.cmake
+#
+# Each SHADER_NAMES entry becomes a `<name>ShaderCode` array in the output header.
+
+list(LENGTH SHADER_FILES numFiles)
+list(LENGTH SHADER_NAMES numNames)
+if (NOT numFiles EQUAL numNames)
+    message(FATAL_ERROR "SHADER_FILES and SHADER_NAMES need to have the same length.")
+endif()
+
+set(headerText "// Generated by EmbedShaders.cmake - do not edit.\n#pragma once\n\n")
+
+math(EXPR lastIdx "${numFiles} - 1")
+foreach(idx RANGE ${lastIdx})
+    list(GET SHADER_FILES ${idx} shaderFile)
+    list(GET SHADER_NAMES ${idx} shaderName)
+
+    file(READ ${shaderFile} shaderHex HEX)
+    # 16 bytes per line, then every byte pair becomes a 0x?? literal.
+    string(REPEAT "[0-9a-f]" 32 lineOfHex)
+    string(REGEX REPLACE "(${lineOfHex})" "\\1\n    " shaderHex "${shaderHex}")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," shaderBytes "${shaderHex}")
+
+    get_filename_component(shaderFileName ${shaderFile} NAME)
+    string(APPEND headerText
+        "// ${shaderFileName}\n"
+        "alignas(16) static const unsigned char ${shaderName}ShaderCode[] = {\n"
+        "    ${shaderBytes}\n"
+        "};\n\n"
+    )
+endforeach()
+
+# Only touch the header when its contents change, to avoid needless rebuilds.
+if (EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} previousHeaderText)
+endif()
+if (NOT "${previousHeaderText}" STREQUAL "${headerText}")
+    file(WRITE ${OUTPUT} "${headerText}")
+endif()
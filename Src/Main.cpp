@@ -8,6 +8,7 @@
 #include <SDL3/SDL_events.h>
 #include <SDL3/SDL_gpu.h>
 #include <SDL3/SDL_init.h>
+#include <SDL3/SDL_thread.h>
 #include <SDL3/SDL_timer.h>
 #include <SDL3/SDL_video.h>
 
@@ -16,36 +17,368 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
+#include "EmbeddedShaders.h"
+
 #include <chrono>
 #include <cstddef>
 #include <cstdio>
 #include <random>
 #include <vector>
 
+// Bits of ConstantBufferData::thumbnailFlags - keep in sync with THUMBNAIL_* in cs.hlsl.
+//  The thumbnail texture holds raw (Y, U, V, 1) DC coefficients; RGB only happens for display and saving.
+enum ThumbnailFlags : Uint32 {
+    ThumbnailFlags_Enable    = 1 << 0, // Write every 8x8 block's DC terms to the thumbnail texture.
+    ThumbnailFlags_Quantized = 1 << 1, // Write the quantized DC terms instead of the exact ones.
+    ThumbnailFlags_DcOnly    = 1 << 2, // Only compute the thumbnail; skip AC terms and the output texture.
+};
+
 struct ConstantBufferData {
     Uint32 frameWidth;
     Uint32 frameHeight;
     Uint32 rowByteStride;
     Uint32 uvByteOffset;
-    Uint32 padding[60];
+    Uint32 thumbnailFlags;
+    Uint32 padding[59];
     float quantTable[8][8];
     float quantTableInv[8][8];
 };
 static_assert((sizeof(ConstantBufferData) % 256 == 0), "ConstantBufferData needs to be sized a multiple of 256 bytes. D3D requires that.");
 
-void ResizeBuffersForCamera(SDL_Camera* pCamera
+struct DisplayConstantBufferData {
+    Uint32 isDcThumbnail;
+    Uint32 padding[63];
+};
+static_assert((sizeof(DisplayConstantBufferData) % 256 == 0), "DisplayConstantBufferData needs to be sized a multiple of 256 bytes. D3D requires that.");
+
+// Converts the raw YUV DC terms read back from the DC thumbnail into RGBA8 pixels, like fs.hlsl does.
+void DcThumbnailToRgba8(const float* pDcTerms, Uint32 numPixels, Uint8* pRgba) {
+    const auto toUnorm8 = [](float x) {
+        return Uint8(SDL_clamp(x, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+    for (Uint32 idx = 0; idx < numPixels; ++idx) {
+        // An orthonormal 8x8 DCT's DC term is 8 times the block average.
+        const float y = pDcTerms[4 * idx + 0] / 8.0f;
+        const float u = pDcTerms[4 * idx + 1] / 8.0f;
+        const float v = pDcTerms[4 * idx + 2] / 8.0f;
+        pRgba[4 * idx + 0] = toUnorm8(y + 1.402f * v);
+        pRgba[4 * idx + 1] = toUnorm8(y - 0.34414f * u - 0.71414f * v);
+        pRgba[4 * idx + 2] = toUnorm8(y + 1.772f * u);
+        pRgba[4 * idx + 3] = 255;
+    }
+}
+
+// Identifies one set of per-camera frame resources. Two cameras that advertise the
+//  same resolution and pixel format can share (and reuse) the exact same allocations.
+struct FrameResourceKey {
+    Uint32 width;
+    Uint32 height;
+    SDL_PixelFormat format;
+
+    bool operator==(const FrameResourceKey& other) const {
+        return (width == other.width) && (height == other.height) && (format == other.format);
+    }
+};
+
+struct FrameResources {
+    SDL_GPUTransferBuffer* txBuffer = nullptr;
+    SDL_GPUTransferBuffer* rxBuffer = nullptr;
+    SDL_GPUBuffer* gpuCameraFrame = nullptr;
+    SDL_GPUTexture* cameraTexture = nullptr;
+    SDL_GPUTexture* dcThumbnailTexture = nullptr;
+};
+
+// Keeps the upload/readback buffers, GPU frame buffer, and output texture of every
+//  resolution we've seen alive, so that switching (or reconnecting) cameras doesn't
+//  reallocate anything. Entries are evicted least-recently-used first once the total
+//  footprint would go over the memory cap.
+class FrameResourcePool {
+public:
+    explicit FrameResourcePool(Uint64 memoryCapBytes)
+        : memoryCapBytes(memoryCapBytes)
+    {}
+
+    // Frame is 1 plane of Y in full res, and one interleaved U+V plane in half-res (width * helf-height)
+    static Uint32 YuvFrameSizeBytes(Uint32 width, Uint32 height) {
+        return (3 * width * height) / 2;
+    }
+
+    // One thumbnail pixel per 8x8 block, and the compute kernel only covers whole 16x16 blocks.
+    static Uint32 DcThumbnailDim(Uint32 frameDim) {
+        return (frameDim / 16) * 2;
+    }
+
+    // Upload + GPU copies of the YUV frame, the RGBA texture and its readback buffer, and the
+    //  float4 DC thumbnail (which is read back through the same, larger, buffer).
+    static Uint64 FootprintBytes(const FrameResourceKey& key) {
+        const Uint64 rgbaSizeBytes = Uint64(key.width) * key.height * 4;
+        const Uint64 thumbnailSizeBytes = Uint64(DcThumbnailDim(key.width)) * DcThumbnailDim(key.height) * 16;
+        return (2 * Uint64(YuvFrameSizeBytes(key.width, key.height))) + (2 * rgbaSizeBytes) + thumbnailSizeBytes;
+    }
+
+    // Returns the resources for `key`, creating them if needed. Never evicts the entry
+    //  whose resources are `inUse`, so that a failed acquisition leaves the caller with
+    //  something valid to keep rendering with.
+    bool Acquire(SDL_GPUDevice* pDevice, const FrameResourceKey& key, const FrameResources& inUse, FrameResources* pOut) {
+        ++useCounter;
+        for (Entry& entry : entries) {
+            if (entry.key == key) {
+                entry.lastUse = useCounter;
+                *pOut = entry.resources;
+                return true;
+            }
+        }
+
+        const Uint64 footprint = FootprintBytes(key);
+        if (footprint > memoryCapBytes) {
+            spdlog::warn("Frame resources for {}x{} ({} MiB) exceed the pool cap of {} MiB; allocating anyway."
+                , key.width
+                , key.height
+                , footprint >> 20
+                , memoryCapBytes >> 20
+            );
+        }
+        while ((usedBytes + footprint > memoryCapBytes) && EvictLeastRecentlyUsed(pDevice, inUse)) {}
+
+        Entry entry;
+        entry.key = key;
+        entry.lastUse = useCounter;
+        if (!CreateResources(pDevice, key, &entry.resources)) {
+            // Drop everything we're not rendering with and try one more time; VRAM may
+            //  just be fragmented or taken up by stale resolutions.
+            while (EvictLeastRecentlyUsed(pDevice, inUse)) {}
+            if (!CreateResources(pDevice, key, &entry.resources)) {
+                return false;
+            }
+        }
+
+        usedBytes += footprint;
+        entries.push_back(entry);
+        *pOut = entry.resources;
+        return true;
+    }
+
+    // Allocates resources for `key` ahead of time, as long as they fit under the cap
+    //  without evicting anything.
+    void Prewarm(SDL_GPUDevice* pDevice, const FrameResourceKey& key) {
+        for (const Entry& entry : entries) {
+            if (entry.key == key) {
+                return;
+            }
+        }
+        const Uint64 footprint = FootprintBytes(key);
+        if (usedBytes + footprint > memoryCapBytes) {
+            spdlog::info("Skipping pre-warm of {}x{}: pool is full.", key.width, key.height);
+            return;
+        }
+
+        Entry entry;
+        entry.key = key;
+        entry.lastUse = 0;
+        if (CreateResources(pDevice, key, &entry.resources)) {
+            usedBytes += footprint;
+            entries.push_back(entry);
+            spdlog::info("Pre-warmed frame resources for {}x{} ({} MiB in pool).", key.width, key.height, usedBytes >> 20);
+        }
+    }
+
+    void ReleaseAll(SDL_GPUDevice* pDevice) {
+        for (Entry& entry : entries) {
+            ReleaseResources(pDevice, &entry.resources);
+        }
+        entries.clear();
+        usedBytes = 0;
+    }
+
+private:
+    struct Entry {
+        FrameResourceKey key;
+        FrameResources resources;
+        Uint64 lastUse;
+    };
+
+    bool EvictLeastRecentlyUsed(SDL_GPUDevice* pDevice, const FrameResources& inUse) {
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->resources.cameraTexture == inUse.cameraTexture) {
+                continue;
+            }
+            if (victim == entries.end() || it->lastUse < victim->lastUse) {
+                victim = it;
+            }
+        }
+        if (victim == entries.end()) {
+            return false;
+        }
+
+        spdlog::info("Evicting frame resources for {}x{}.", victim->key.width, victim->key.height);
+        usedBytes -= FootprintBytes(victim->key);
+        ReleaseResources(pDevice, &victim->resources);
+        entries.erase(victim);
+        return true;
+    }
+
+    static bool CreateResources(SDL_GPUDevice* pDevice, const FrameResourceKey& key, FrameResources* pResources) {
+        const Uint32 webcamYuvFrameSizeBytes = YuvFrameSizeBytes(key.width, key.height);
+
+        // Create YUV upload buffer
+        pResources->txBuffer = [&] {
+            SDL_GPUTransferBufferCreateInfo txBufferInfo;
+                txBufferInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+                txBufferInfo.size = webcamYuvFrameSizeBytes;
+                txBufferInfo.props = 0;
+            return SDL_CreateGPUTransferBuffer(pDevice, &txBufferInfo);
+        }();
+        if (pResources->txBuffer == nullptr) {
+            spdlog::error("Could not create image upload buffer! Error: {}", SDL_GetError());
+            ReleaseResources(pDevice, pResources);
+            return false;
+        }
+
+        // Create Texture download buffer
+        pResources->rxBuffer = [&] {
+            SDL_GPUTransferBufferCreateInfo rxBufferInfo;
+                rxBufferInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
+                rxBufferInfo.size = key.width * key.height * 4;
+                rxBufferInfo.props = 0;
+                return SDL_CreateGPUTransferBuffer(pDevice, &rxBufferInfo);
+        }();
+        if (pResources->rxBuffer == nullptr) {
+            spdlog::error("Could not create image download buffer! Error: {}", SDL_GetError());
+            ReleaseResources(pDevice, pResources);
+            return false;
+        }
+
+        // Create YUV GPU buffer
+        pResources->gpuCameraFrame = [&] {
+            SDL_GPUBufferCreateInfo gpuCameraFrameBufferInfo;
+            gpuCameraFrameBufferInfo.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ;
+            gpuCameraFrameBufferInfo.size = webcamYuvFrameSizeBytes;
+            gpuCameraFrameBufferInfo.props = 0;
+            return SDL_CreateGPUBuffer(pDevice, &gpuCameraFrameBufferInfo);
+        }();
+        if (pResources->gpuCameraFrame == nullptr) {
+            spdlog::error("Could not create GPU camera frame. Are we out of VRAM?");
+            ReleaseResources(pDevice, pResources);
+            return false;
+        }
+        SDL_SetGPUBufferName(pDevice, pResources->gpuCameraFrame, "GPU Camera Frame");
+
+        // Create output texture
+        pResources->cameraTexture = [&] {
+            SDL_GPUTextureCreateInfo texCreateInfo;
+            texCreateInfo.type = SDL_GPU_TEXTURETYPE_2D;
+            texCreateInfo.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+            texCreateInfo.width = key.width;
+            texCreateInfo.height = key.height;
+            texCreateInfo.layer_count_or_depth = 1;
+            texCreateInfo.num_levels = 1;
+            texCreateInfo.sample_count = SDL_GPU_SAMPLECOUNT_1;
+            texCreateInfo.usage = 0
+                | SDL_GPU_TEXTUREUSAGE_GRAPHICS_STORAGE_READ
+                | SDL_GPU_TEXTUREUSAGE_COMPUTE_STORAGE_WRITE
+            ;
+            texCreateInfo.props = 0;
+            return SDL_CreateGPUTexture(pDevice, &texCreateInfo);
+        }();
+        if (pResources->cameraTexture == nullptr) {
+            spdlog::error("Could not create GPU texture for compute shader output. Are we out of VRAM?");
+            ReleaseResources(pDevice, pResources);
+            return false;
+        }
+        SDL_SetGPUTextureName(pDevice, pResources->cameraTexture, "Output RGB (fried) Texture");
+
+        // Create DC thumbnail texture
+        pResources->dcThumbnailTexture = [&] {
+            SDL_GPUTextureCreateInfo texCreateInfo;
+            texCreateInfo.type = SDL_GPU_TEXTURETYPE_2D;
+            // Raw YUV DC coefficients, not colors - see cs.hlsl.
+            texCreateInfo.format = SDL_GPU_TEXTUREFORMAT_R32G32B32A32_FLOAT;
+            texCreateInfo.width = DcThumbnailDim(key.width);
+            texCreateInfo.height = DcThumbnailDim(key.height);
+            texCreateInfo.layer_count_or_depth = 1;
+            texCreateInfo.num_levels = 1;
+            texCreateInfo.sample_count = SDL_GPU_SAMPLECOUNT_1;
+            texCreateInfo.usage = 0
+                | SDL_GPU_TEXTUREUSAGE_GRAPHICS_STORAGE_READ
+                | SDL_GPU_TEXTUREUSAGE_COMPUTE_STORAGE_WRITE
+            ;
+            texCreateInfo.props = 0;
+            return SDL_CreateGPUTexture(pDevice, &texCreateInfo);
+        }();
+        if (pResources->dcThumbnailTexture == nullptr) {
+            spdlog::error("Could not create GPU texture for the DC thumbnail. Are we out of VRAM?");
+            ReleaseResources(pDevice, pResources);
+            return false;
+        }
+        SDL_SetGPUTextureName(pDevice, pResources->dcThumbnailTexture, "DC Thumbnail Texture");
+
+        return true;
+    }
+
+    static void ReleaseResources(SDL_GPUDevice* pDevice, FrameResources* pResources) {
+        if (pResources->txBuffer) {
+            SDL_ReleaseGPUTransferBuffer(pDevice, pResources->txBuffer);
+        }
+        if (pResources->rxBuffer) {
+            SDL_ReleaseGPUTransferBuffer(pDevice, pResources->rxBuffer);
+        }
+        if (pResources->gpuCameraFrame) {
+            SDL_ReleaseGPUBuffer(pDevice, pResources->gpuCameraFrame);
+        }
+        if (pResources->cameraTexture) {
+            SDL_ReleaseGPUTexture(pDevice, pResources->cameraTexture);
+        }
+        if (pResources->dcThumbnailTexture) {
+            SDL_ReleaseGPUTexture(pDevice, pResources->dcThumbnailTexture);
+        }
+        *pResources = FrameResources{};
+    }
+
+    std::vector<Entry> entries;
+    Uint64 memoryCapBytes;
+    Uint64 usedBytes = 0;
+    Uint64 useCounter = 0;
+};
+
+// Allocates frame resources up front for the preferred format of every attached
+//  camera, so that the first switch to any of them is as cheap as the following ones.
+void PrewarmFrameResourcePool(SDL_GPUDevice *pDevice, FrameResourcePool *pPool) {
+    int cameraCount = 0;
+    SDL_CameraID* cameras = SDL_GetCameras(&cameraCount);
+    if (cameras == nullptr) {
+        return;
+    }
+    for (int idx = 0; idx < cameraCount; ++idx) {
+        int specCount = 0;
+        SDL_CameraSpec** specs = SDL_GetCameraSupportedFormats(cameras[idx], &specCount);
+        if (specs == nullptr) {
+            continue;
+        }
+        // SDL sorts formats from most to least preferred, which is what
+        //  SDL_OpenCamera(id, nullptr) ends up picking.
+        if (specCount > 0) {
+            const FrameResourceKey key = {Uint32(specs[0]->width), Uint32(specs[0]->height), specs[0]->format};
+            pPool->Prewarm(pDevice, key);
+        }
+        SDL_free(specs);
+    }
+    SDL_free(cameras);
+}
+
+// Points the frame resources at the pool entry matching the camera's current format.
+//  On failure, leaves all outputs untouched so that the caller can keep using them.
+bool ResizeBuffersForCamera(SDL_Camera* pCamera
     , SDL_GPUDevice *pDevice
-    , SDL_GPUTransferBuffer **ppTxBuffer
-    , SDL_GPUTransferBuffer **ppRxBuffer
-    , SDL_GPUBuffer **ppBuffer
-    , SDL_GPUTexture **ppTexture
+    , FrameResourcePool *pPool
+    , FrameResources *pResources
     , ConstantBufferData *pCBufData
     , bool *pIsNv12Format
 ) {
     SDL_CameraSpec cameraFormat = {};
     if (!SDL_GetCameraFormat(pCamera, &cameraFormat)) {
-        spdlog::error("Could not get camera format.");
-        exit(1);
+        spdlog::error("Could not get camera format. Error: {}", SDL_GetError());
+        return false;
     }
     else {
         spdlog::info("Camera spec:\n"
@@ -63,212 +396,65 @@ void ResizeBuffersForCamera(SDL_Camera* pCamera
             , float(cameraFormat.framerate_numerator) / float(cameraFormat.framerate_denominator)
         );
     }
-    // Frame is 1 plane of Y in full res, and one interleaved U+V plane in half-res (width * helf-height)
-    const Uint32 webcamYuvFrameSizeBytes = (3 * cameraFormat.width * cameraFormat.height) / 2;
-    
+
+    const FrameResourceKey key = {Uint32(cameraFormat.width), Uint32(cameraFormat.height), cameraFormat.format};
+    FrameResources resources;
+    if (!pPool->Acquire(pDevice, key, *pResources, &resources)) {
+        spdlog::error("Could not allocate frame resources for {}x{}.", key.width, key.height);
+        return false;
+    }
+    *pResources = resources;
+
     pCBufData->frameWidth = cameraFormat.width;
     pCBufData->frameHeight = cameraFormat.height;
     pCBufData->rowByteStride = cameraFormat.width;
     pCBufData->uvByteOffset = cameraFormat.width * cameraFormat.height;
-    
-    if (*ppTxBuffer) {
-        SDL_ReleaseGPUTransferBuffer(pDevice, *ppTxBuffer);
-    }
-    if (*ppRxBuffer) {
-        SDL_ReleaseGPUTransferBuffer(pDevice, *ppRxBuffer);
-    }
-    if (*ppBuffer) {
-        SDL_ReleaseGPUBuffer(pDevice, *ppBuffer);
-    }
-    if (*ppTexture) {
-        SDL_ReleaseGPUTexture(pDevice, *ppTexture);
-    }
-    
-    // Create YUV upload buffer
-    *ppTxBuffer = [&] {
-        SDL_GPUTransferBufferCreateInfo txBufferInfo;
-            txBufferInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-            txBufferInfo.size = webcamYuvFrameSizeBytes;
-            txBufferInfo.props = 0;
-        return SDL_CreateGPUTransferBuffer(pDevice, &txBufferInfo);
-    }();
-    if (*ppTxBuffer == nullptr) {
-        spdlog::error("Could not create image upload buffer! Error: {}", SDL_GetError());
-        exit(-1);
-    }
 
-    // Create Texture download buffer
-    *ppRxBuffer = [&] {
-        SDL_GPUTransferBufferCreateInfo rxBufferInfo;
-            rxBufferInfo.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
-            rxBufferInfo.size = cameraFormat.width * cameraFormat.height * 4;
-            rxBufferInfo.props = 0;
-            return SDL_CreateGPUTransferBuffer(pDevice, &rxBufferInfo);
-    }();
-    if (*ppRxBuffer == nullptr) {
-        spdlog::error("Could not create image download buffer! Error: {}", SDL_GetError());
-        exit(-1);
-    }
-    
-    // Create YUV GPU buffer
-    *ppBuffer = [&] {
-        SDL_GPUBufferCreateInfo gpuCameraFrameBufferInfo;
-        gpuCameraFrameBufferInfo.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ;
-        gpuCameraFrameBufferInfo.size = webcamYuvFrameSizeBytes;
-        return SDL_CreateGPUBuffer(pDevice, &gpuCameraFrameBufferInfo);
-    }();
-    if (*ppBuffer == nullptr) {
-        spdlog::error("Could not create GPU camera frame. Are we out of VRAM?");
-        exit(-1);
-    }
-    SDL_SetGPUBufferName(pDevice, *ppBuffer, "GPU Camera Frame");
-
-    // Create output texture
-    *ppTexture = [&] {
-        SDL_GPUTextureCreateInfo texCreateInfo;
-        texCreateInfo.type = SDL_GPU_TEXTURETYPE_2D;
-        texCreateInfo.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
-        texCreateInfo.width = cameraFormat.width;
-        texCreateInfo.height = cameraFormat.height;
-        texCreateInfo.layer_count_or_depth = 1;
-        texCreateInfo.num_levels = 1;
-        texCreateInfo.sample_count = SDL_GPU_SAMPLECOUNT_1;
-        texCreateInfo.usage = 0
-            | SDL_GPU_TEXTUREUSAGE_GRAPHICS_STORAGE_READ
-            | SDL_GPU_TEXTUREUSAGE_COMPUTE_STORAGE_WRITE
-        ;
-        return SDL_CreateGPUTexture(pDevice, &texCreateInfo);
-    }();
-    if (*ppTexture == nullptr) {
-        spdlog::error("Could not create GPU texture for compute shader output. Are we out of VRAM?");
-    }
-    SDL_SetGPUTextureName(pDevice, *ppTexture, "Output RGB (fried) Texture");
-    
     *pIsNv12Format = (cameraFormat.format == SDL_PIXELFORMAT_NV12);
+    return true;
 }
 
 
-int main(int argc, char** args) {
-    const bool debugMode = true;
-    const char* preferredGpu = nullptr;
+// Everything the render loop needs that doesn't depend on the camera. Built on a worker
+//  thread while the main thread waits on camera permissions, as SDL_gpu allows creating
+//  resources from any thread.
+struct PipelineBuildJob {
+    SDL_GPUDevice* gpu = nullptr;
+    SDL_GPUTextureFormat swapchainFormat = SDL_GPU_TEXTUREFORMAT_INVALID;
 
-    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_CAMERA);
+    SDL_GPUGraphicsPipeline* gfxPipe = nullptr;
+    SDL_GPUComputePipeline* computePipe = nullptr;
+    SDL_GPUSampler* sampler = nullptr;
+    Uint64 elapsedNs = 0;
+    bool succeeded = false;
+};
 
-    SDL_GPUDevice* gpu = SDL_CreateGPUDevice(
-#if defined(__APPLE__)
-        SDL_GPU_SHADERFORMAT_METALLIB,
-#elif defined(_WIN32)
-        SDL_GPU_SHADERFORMAT_DXIL,
-#endif
-        debugMode,
-        preferredGpu
-    );
-    if (gpu == nullptr) {
-        spdlog::error("Could not create GPU.");
+// Releases whatever BuildPipelines managed to create, so that a failed build leaks nothing.
+void ReleasePipelines(PipelineBuildJob* pJob) {
+    if (pJob->gfxPipe) {
+        SDL_ReleaseGPUGraphicsPipeline(pJob->gpu, pJob->gfxPipe);
     }
-
-    spdlog::info("Created GPU with driver {}", SDL_GetGPUDeviceDriver(gpu));
-
-    SDL_CameraID currentCamera = -1;
-    const char* currentCameraName = "No Camera";
-    SDL_Camera* webcam = [&] {
-        int cameraCount = 0;
-        SDL_CameraID* cameras = SDL_GetCameras(&cameraCount);
-        if (cameras == nullptr) {
-            spdlog::error("No cameras attached to this system. Error: {}", SDL_GetError());
-            exit(-1);
-        }
-        for (int idx = 0; idx < cameraCount; ++idx) {
-            SDL_Camera* tryCamera = SDL_OpenCamera(cameras[idx], nullptr);
-            if (tryCamera != nullptr) {
-                currentCamera = cameras[idx];
-                currentCameraName = SDL_GetCameraName(currentCamera);
-                SDL_free(cameras);
-                return tryCamera;
-            }
-        }
-
-        spdlog::error("Could not open any cameras out of {} options.", cameraCount);
-        exit(-1);
-    }();
-
-    {
-        SDL_Event cameraEvent;
-        cameraEvent.type = SDL_EVENT_LAST;
-        int permission = 0;
-
-        while (permission == 0) {
-            permission = SDL_GetCameraPermissionState(webcam);
-            if (permission == 1) {
-                spdlog::info("Camera access granted.");
-                break;
-            }
-            else if (permission == -1) {
-                spdlog::error("User denied camera access.");
-                exit(-1);
-            }
-            SDL_Delay(200);
-        }
+    if (pJob->computePipe) {
+        SDL_ReleaseGPUComputePipeline(pJob->gpu, pJob->computePipe);
     }
-
-    ConstantBufferData cbufData;
-    for (int idx = 0; idx < 60; ++idx) {
-        cbufData.padding[idx] = idx;
+    if (pJob->sampler) {
+        SDL_ReleaseGPUSampler(pJob->gpu, pJob->sampler);
     }
-    SDL_GPUTransferBuffer* txBuffer = nullptr;
-    SDL_GPUTransferBuffer* rxBuffer = nullptr;
-    SDL_GPUBuffer* gpuCameraFrame = nullptr;
-    SDL_GPUTexture* cameraTexture = nullptr;
-    bool isNV12Format = false;
-    ResizeBuffersForCamera(webcam, gpu, &txBuffer, &rxBuffer, &gpuCameraFrame, &cameraTexture, &cbufData, &isNV12Format);
-
-    // Now, create window, swapchain texture, and pipelines.
-    SDL_Window* window = SDL_CreateWindow("FriedCamera", 1280, 720, SDL_WINDOW_HIGH_PIXEL_DENSITY);
-    SDL_ClaimWindowForGPUDevice(gpu, window);
-    SDL_SetGPUSwapchainParameters(gpu, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_VSYNC);
-
-
-    // Setup Dear ImGui context - most of the code is straight from https://github.com/ocornut/imgui/pull/8163/files#diff-3ef28c917731f41f2381f195496078a9eb430fe357c9ef11cfb9226024282777
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO(); (void)io;
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
+    pJob->gfxPipe = nullptr;
+    pJob->computePipe = nullptr;
+    pJob->sampler = nullptr;
+    pJob->succeeded = false;
+}
 
-    // Setup Platform/Renderer backends
-    ImGui_ImplSDL3_InitForOther(window);
-    ImGui_ImplSDLGPU3_InitInfo init_info = {};
-    init_info.Device = gpu;
-    init_info.ColorTargetFormat = SDL_GetGPUSwapchainTextureFormat(gpu, window);
-    init_info.MSAASamples = SDL_GPU_SAMPLECOUNT_1;
-    ImGui_ImplSDLGPU3_Init(&init_info);
-
-    const auto shaderFormats = SDL_GetGPUShaderFormats(gpu);
-#if defined(__APPLE__)
-    if (!(shaderFormats & SDL_GPU_SHADERFORMAT_METALLIB)) {
-        spdlog::error("This GPU doesn't support Metal.");
-    }
-#elif defined(_WIN32)
-    if (!(shaderFormats & SDL_GPU_SHADERFORMAT_DXIL)) {
-        spdlog::error("This GPU doesn't support DXIL.");
-    }
-#endif
+int BuildPipelines(void* pUserData) {
+    auto* pJob = static_cast<PipelineBuildJob*>(pUserData);
+    SDL_GPUDevice* gpu = pJob->gpu;
+    const Uint64 startNs = SDL_GetTicksNS();
 
     SDL_GPUShader* vertexShader = [&] {
-        size_t shaderSize;
-#if defined(__APPLE__)
-        const auto* shaderCode = static_cast<Uint8*>(SDL_LoadFile("vs.metallib", &shaderSize));
-#elif defined(_WIN32)
-        const auto* shaderCode = static_cast<Uint8*>(SDL_LoadFile("vs.dxil", &shaderSize));
-#endif
-        if (shaderCode == nullptr) {
-            spdlog::error("Vertex shader could not be found!!");
-            exit(-1);
-        }
-
         SDL_GPUShaderCreateInfo vertexShaderCreateInfo{0};
-        vertexShaderCreateInfo.code = shaderCode;
-        vertexShaderCreateInfo.code_size = shaderSize;
+        vertexShaderCreateInfo.code = vsShaderCode;
+        vertexShaderCreateInfo.code_size = sizeof(vsShaderCode);
         vertexShaderCreateInfo.entrypoint = "VSMain";
 #if defined(__APPLE__)
         vertexShaderCreateInfo.format = SDL_GPU_SHADERFORMAT_METALLIB;
@@ -282,7 +468,6 @@ int main(int argc, char** args) {
         SDL_GPUShader* vertexShader = SDL_CreateGPUShader(gpu, &vertexShaderCreateInfo);
         if (vertexShader == nullptr) {
             spdlog::error("Failed to create vertex shader!");
-            exit(-1);
         }
         else {
             spdlog::info("Vertex shader created.");
@@ -292,20 +477,9 @@ int main(int argc, char** args) {
     }();
 
     SDL_GPUShader* fragShader = [&] {
-        size_t shaderSize;
-#if defined(__APPLE__)
-        const auto* shaderCode = static_cast<Uint8*>(SDL_LoadFile("fs.metallib", &shaderSize));
-#elif defined(_WIN32)
-        const auto* shaderCode = static_cast<Uint8*>(SDL_LoadFile("fs.dxil", &shaderSize));
-#endif
-        if (shaderCode == nullptr) {
-            spdlog::error("Fragment shader could not be found!!");
-            exit(-1);
-        }
-
         SDL_GPUShaderCreateInfo fragShaderCreateInfo{0};
-        fragShaderCreateInfo.code = shaderCode;
-        fragShaderCreateInfo.code_size = shaderSize;
+        fragShaderCreateInfo.code = fsShaderCode;
+        fragShaderCreateInfo.code_size = sizeof(fsShaderCode);
         fragShaderCreateInfo.entrypoint = "FSMain";
 #if defined(__APPLE__)
         fragShaderCreateInfo.format = SDL_GPU_SHADERFORMAT_METALLIB;
@@ -315,11 +489,11 @@ int main(int argc, char** args) {
         fragShaderCreateInfo.stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
         // Yes, we need a sampler object for the frag shader.
         fragShaderCreateInfo.num_samplers = 1;
+        fragShaderCreateInfo.num_uniform_buffers = 1;
 
         SDL_GPUShader* fragShader = SDL_CreateGPUShader(gpu, &fragShaderCreateInfo);
         if (fragShader == nullptr) {
             spdlog::error("Failed to create fragment shader!");
-            exit(-1);
         }
         else {
             spdlog::info("Fragment shader created.");
@@ -328,6 +502,15 @@ int main(int argc, char** args) {
         return fragShader;
     }();
 
+    if (vertexShader == nullptr || fragShader == nullptr) {
+        if (vertexShader) {
+            SDL_ReleaseGPUShader(gpu, vertexShader);
+        }
+        if (fragShader) {
+            SDL_ReleaseGPUShader(gpu, fragShader);
+        }
+        return -1;
+    }
 
     const auto graphicsPipelineInfo = [&] {
         SDL_GPUGraphicsPipelineCreateInfo graphicsPipelineInfo{0};
@@ -349,9 +532,9 @@ int main(int argc, char** args) {
             return rasterState;
         }();
         graphicsPipelineInfo.target_info = [&] {
-            static const auto tgtDesc = [&gpu, &window] {
+            static const auto tgtDesc = [pJob] {
                 SDL_GPUColorTargetDescription tgtDesc;
-                tgtDesc.format = SDL_GetGPUSwapchainTextureFormat(gpu, window);
+                tgtDesc.format = pJob->swapchainFormat;
 				tgtDesc.blend_state = [] {
                     SDL_GPUColorTargetBlendState blendState{};
                     blendState.enable_blend = false;
@@ -375,9 +558,13 @@ int main(int argc, char** args) {
         return graphicsPipelineInfo;
     }();
 
-    SDL_GPUGraphicsPipeline* gfxPipe = SDL_CreateGPUGraphicsPipeline(gpu, &graphicsPipelineInfo);
+    pJob->gfxPipe = SDL_CreateGPUGraphicsPipeline(gpu, &graphicsPipelineInfo);
+
+    // The pipeline keeps what it needs from the shaders.
+    SDL_ReleaseGPUShader(gpu, vertexShader);
+    SDL_ReleaseGPUShader(gpu, fragShader);
 
-    if (gfxPipe == nullptr) {
+    if (pJob->gfxPipe == nullptr) {
         spdlog::error("Failed to create graphics pipeline!");
         return -1;
     }
@@ -385,17 +572,10 @@ int main(int argc, char** args) {
         spdlog::info("Graphics pipeline created.");
     }
 
-    SDL_GPUComputePipeline* computePipe = [&] {
-        size_t shaderSize;
-    #if defined(__APPLE__)
-        void* shaderCode = SDL_LoadFile("cs.metallib", &shaderSize);
-    #elif defined(_WIN32)
-        void* shaderCode = SDL_LoadFile("cs.dxil", &shaderSize);
-    #endif
-
+    pJob->computePipe = [&] {
         SDL_GPUComputePipelineCreateInfo computePipeInfo = {0};
-        computePipeInfo.code = reinterpret_cast<Uint8*>(shaderCode);
-        computePipeInfo.code_size = shaderSize;
+        computePipeInfo.code = csShaderCode;
+        computePipeInfo.code_size = sizeof(csShaderCode);
     #if defined(__APPLE__)
         computePipeInfo.entrypoint = "CSMain";
         computePipeInfo.format = SDL_GPU_SHADERFORMAT_METALLIB;
@@ -404,7 +584,7 @@ int main(int argc, char** args) {
         computePipeInfo.format = SDL_GPU_SHADERFORMAT_DXIL;
     #endif
         computePipeInfo.num_readonly_storage_textures = 0;
-        computePipeInfo.num_readwrite_storage_textures = 1;
+        computePipeInfo.num_readwrite_storage_textures = 2;
         computePipeInfo.num_readonly_storage_buffers = 1;
         computePipeInfo.num_readwrite_storage_buffers = 0;
         computePipeInfo.num_samplers = 0;
@@ -424,8 +604,12 @@ int main(int argc, char** args) {
 
         return computePipe;
     }();
+    if (pJob->computePipe == nullptr) {
+        ReleasePipelines(pJob);
+        return -1;
+    }
 
-    SDL_GPUSampler* sampler = [&]{
+    pJob->sampler = [&]{
         SDL_GPUSamplerCreateInfo samplerInfo = {};
         samplerInfo.min_filter = SDL_GPU_FILTER_LINEAR;
         samplerInfo.mag_filter = SDL_GPU_FILTER_LINEAR;
@@ -445,11 +629,190 @@ int main(int argc, char** args) {
 
         if (!sampler) {
             spdlog::error("Could not create sampler object!");
-            exit(-1);
         }
         return sampler;
     }();
-    
+    if (pJob->sampler == nullptr) {
+        ReleasePipelines(pJob);
+        return -1;
+    }
+
+    pJob->succeeded = true;
+    pJob->elapsedNs = SDL_GetTicksNS() - startNs;
+    return 0;
+}
+
+
+int main(int argc, char** args) {
+    const bool debugMode = true;
+    const char* preferredGpu = nullptr;
+
+    // Startup is timed stage by stage, so that regressions in time-to-first-frame show up in the log.
+    const Uint64 startupBeginNs = SDL_GetTicksNS();
+    Uint64 stageBeginNs = startupBeginNs;
+    const auto endStage = [&stageBeginNs] {
+        const Uint64 nowNs = SDL_GetTicksNS();
+        const double stageMs = double(nowNs - stageBeginNs) / 1e6;
+        stageBeginNs = nowNs;
+        return stageMs;
+    };
+
+    SDL_Init(SDL_INIT_VIDEO | SDL_INIT_CAMERA);
+
+    SDL_GPUDevice* gpu = SDL_CreateGPUDevice(
+#if defined(__APPLE__)
+        SDL_GPU_SHADERFORMAT_METALLIB,
+#elif defined(_WIN32)
+        SDL_GPU_SHADERFORMAT_DXIL,
+#endif
+        debugMode,
+        preferredGpu
+    );
+    if (gpu == nullptr) {
+        spdlog::error("Could not create GPU.");
+    }
+
+    spdlog::info("Created GPU with driver {}", SDL_GetGPUDeviceDriver(gpu));
+
+    const auto shaderFormats = SDL_GetGPUShaderFormats(gpu);
+#if defined(__APPLE__)
+    if (!(shaderFormats & SDL_GPU_SHADERFORMAT_METALLIB)) {
+        spdlog::error("This GPU doesn't support Metal.");
+    }
+#elif defined(_WIN32)
+    if (!(shaderFormats & SDL_GPU_SHADERFORMAT_DXIL)) {
+        spdlog::error("This GPU doesn't support DXIL.");
+    }
+#endif
+    const double deviceMs = endStage();
+
+    // Create the window and swapchain first, since the graphics pipeline needs to know
+    //  the swapchain format.
+    //  It stays hidden until startup finishes, so it never shows up unresponsive.
+    SDL_Window* window = SDL_CreateWindow("FriedCamera", 1280, 720, SDL_WINDOW_HIGH_PIXEL_DENSITY | SDL_WINDOW_HIDDEN);
+    SDL_ClaimWindowForGPUDevice(gpu, window);
+    SDL_SetGPUSwapchainParameters(gpu, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_VSYNC);
+    const double windowMs = endStage();
+
+    // Build pipelines in the background while we open the camera and wait for permissions.
+    PipelineBuildJob pipelineJob;
+    pipelineJob.gpu = gpu;
+    pipelineJob.swapchainFormat = SDL_GetGPUSwapchainTextureFormat(gpu, window);
+    SDL_Thread* pipelineThread = SDL_CreateThread(BuildPipelines, "PipelineBuilder", &pipelineJob);
+    if (pipelineThread == nullptr) {
+        spdlog::warn("Could not create pipeline builder thread, building pipelines inline. Error: {}", SDL_GetError());
+        BuildPipelines(&pipelineJob);
+    }
+    // Must run before exiting, so that the worker isn't still using the device.
+    const auto finishPipelineBuild = [&pipelineThread] {
+        if (pipelineThread) {
+            SDL_WaitThread(pipelineThread, nullptr);
+            pipelineThread = nullptr;
+        }
+    };
+    const auto exitDuringStartup = [&] {
+        finishPipelineBuild();
+        ReleasePipelines(&pipelineJob);
+        exit(-1);
+    };
+
+    SDL_CameraID currentCamera = -1;
+    const char* currentCameraName = "No Camera";
+    SDL_Camera* webcam = [&]() -> SDL_Camera* {
+        int cameraCount = 0;
+        SDL_CameraID* cameras = SDL_GetCameras(&cameraCount);
+        if (cameras == nullptr) {
+            spdlog::error("No cameras attached to this system. Error: {}", SDL_GetError());
+            return nullptr;
+        }
+        for (int idx = 0; idx < cameraCount; ++idx) {
+            SDL_Camera* tryCamera = SDL_OpenCamera(cameras[idx], nullptr);
+            if (tryCamera != nullptr) {
+                currentCamera = cameras[idx];
+                currentCameraName = SDL_GetCameraName(currentCamera);
+                SDL_free(cameras);
+                return tryCamera;
+            }
+        }
+
+        spdlog::error("Could not open any cameras out of {} options.", cameraCount);
+        SDL_free(cameras);
+        return nullptr;
+    }();
+    if (webcam == nullptr) {
+        exitDuringStartup();
+    }
+    const double cameraOpenMs = endStage();
+
+    {
+        SDL_Event cameraEvent;
+        cameraEvent.type = SDL_EVENT_LAST;
+        int permission = 0;
+
+        while (permission == 0) {
+            permission = SDL_GetCameraPermissionState(webcam);
+            if (permission == 1) {
+                spdlog::info("Camera access granted.");
+                break;
+            }
+            else if (permission == -1) {
+                spdlog::error("User denied camera access.");
+                exitDuringStartup();
+            }
+            // Keep the OS happy while we wait, as the permission prompt may take a while.
+            SDL_PumpEvents();
+            SDL_Delay(200);
+        }
+    }
+    const double cameraPermissionMs = endStage();
+
+    ConstantBufferData cbufData;
+    cbufData.thumbnailFlags = 0;
+    for (int idx = 0; idx < 59; ++idx) {
+        cbufData.padding[idx] = idx;
+    }
+    // Enough for a handful of 1080p cameras, or a couple of 4K ones.
+    static constexpr Uint64 framePoolCapBytes = 256ull << 20;
+    FrameResourcePool framePool(framePoolCapBytes);
+    PrewarmFrameResourcePool(gpu, &framePool);
+
+    FrameResources frameResources;
+    bool isNV12Format = false;
+    if (!ResizeBuffersForCamera(webcam, gpu, &framePool, &frameResources, &cbufData, &isNV12Format)) {
+        spdlog::error("Could not set up frame resources for the initial camera.");
+        exitDuringStartup();
+    }
+    const double frameResourcesMs = endStage();
+
+    // Setup Dear ImGui context - most of the code is straight from https://github.com/ocornut/imgui/pull/8163/files#diff-3ef28c917731f41f2381f195496078a9eb430fe357c9ef11cfb9226024282777
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO(); (void)io;
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
+
+    // Setup Platform/Renderer backends
+    ImGui_ImplSDL3_InitForOther(window);
+    ImGui_ImplSDLGPU3_InitInfo init_info = {};
+    init_info.Device = gpu;
+    init_info.ColorTargetFormat = SDL_GetGPUSwapchainTextureFormat(gpu, window);
+    init_info.MSAASamples = SDL_GPU_SAMPLECOUNT_1;
+    ImGui_ImplSDLGPU3_Init(&init_info);
+    const double imguiMs = endStage();
+
+    finishPipelineBuild();
+    if (!pipelineJob.succeeded) {
+        spdlog::error("Could not build pipelines.");
+        exit(-1);
+    }
+    const double pipelineWaitMs = endStage();
+
+    SDL_GPUGraphicsPipeline* gfxPipe = pipelineJob.gfxPipe;
+    SDL_GPUComputePipeline* computePipe = pipelineJob.computePipe;
+    SDL_GPUSampler* sampler = pipelineJob.sampler;
+
+    SDL_ShowWindow(window);
+
 #if 0 // Debug: capture images in advance so that we can close the camera when not in use.
     FILE* cameraOut = fopen("camera.raw", "wb");
     if (!cameraOut) {
@@ -466,10 +829,10 @@ int main(int argc, char** args) {
         }
         
         {
-            auto* txPointer = static_cast<Uint8*>(SDL_MapGPUTransferBuffer(gpu, txBuffer, false));
+            auto* txPointer = static_cast<Uint8*>(SDL_MapGPUTransferBuffer(gpu, frameResources.txBuffer, false));
             std::copy_n(static_cast<const Uint8*>(cpuCameraSurface->pixels), webcamYuvFrameSizeBytes, txPointer);
             std::copy_n(static_cast<const std::byte*>(cpuCameraSurface->pixels), webcamYuvFrameSizeBytes, cameraMem.begin());
-            SDL_UnmapGPUTransferBuffer(gpu, txBuffer);
+            SDL_UnmapGPUTransferBuffer(gpu, frameResources.txBuffer);
 
         }
         SDL_ReleaseCameraFrame(webcam, cpuCameraSurface);
@@ -485,8 +848,11 @@ int main(int argc, char** args) {
 
     bool shouldExit = false;
     bool saveTexture = false;
+    bool saveThumbnail = false;
+    bool loggedStartupTimings = false;
     SDL_GPUFence* frameFence = nullptr;
-    Uint32 cameraYuvFrameSizeBytes = (3 * cbufData.frameWidth * cbufData.frameHeight) / 2;
+    SDL_CameraID pendingCamera = 0;
+    Uint32 cameraYuvFrameSizeBytes = FrameResourcePool::YuvFrameSizeBytes(cbufData.frameWidth, cbufData.frameHeight);
     char imagePath[64];
     int imageCount = 1;
     SDL_snprintf(imagePath, 64, "Image%d.png", imageCount);
@@ -510,14 +876,53 @@ int main(int argc, char** args) {
             frameFence = nullptr;
         }
         if (saveTexture) {
-            const void* rgbaBuffer = static_cast<Uint32*>(SDL_MapGPUTransferBuffer(gpu, rxBuffer, false)); {
+            const void* rgbaBuffer = static_cast<Uint32*>(SDL_MapGPUTransferBuffer(gpu, frameResources.rxBuffer, false)); {
                 static constexpr int numChannels = 4;
                 stbi_write_png(imagePath, cbufData.frameWidth, cbufData.frameHeight, numChannels, rgbaBuffer, cbufData.frameWidth * 4);
-            } SDL_UnmapGPUTransferBuffer(gpu, rxBuffer);
+            } SDL_UnmapGPUTransferBuffer(gpu, frameResources.rxBuffer);
             ++imageCount;
             SDL_snprintf(imagePath, 64, "Image%d.png", imageCount);
             saveTexture = false;
         }
+        if (saveThumbnail) {
+            const Uint32 thumbnailWidth = FrameResourcePool::DcThumbnailDim(cbufData.frameWidth);
+            const Uint32 thumbnailHeight = FrameResourcePool::DcThumbnailDim(cbufData.frameHeight);
+            std::vector<Uint8> thumbnailRgba(thumbnailWidth * thumbnailHeight * 4);
+            const float* dcTerms = static_cast<float*>(SDL_MapGPUTransferBuffer(gpu, frameResources.rxBuffer, false)); {
+                DcThumbnailToRgba8(dcTerms, thumbnailWidth * thumbnailHeight, thumbnailRgba.data());
+            } SDL_UnmapGPUTransferBuffer(gpu, frameResources.rxBuffer);
+            static constexpr int numChannels = 4;
+            stbi_write_png(imagePath, thumbnailWidth, thumbnailHeight, numChannels, thumbnailRgba.data(), thumbnailWidth * 4);
+            ++imageCount;
+            SDL_snprintf(imagePath, 64, "Image%d.png", imageCount);
+            saveThumbnail = false;
+        }
+
+        // Switch cameras before acquiring a frame, so that we never upload from or render
+        //  with resources that haven't received an image from the new camera yet. Open the
+        //  new camera before closing the current one, so that we can keep streaming from
+        //  the old camera if anything goes wrong.
+        if (pendingCamera != 0) {
+            const Uint64 switchStart = SDL_GetPerformanceCounter();
+            SDL_Camera* newWebcam = SDL_OpenCamera(pendingCamera, nullptr);
+            if (newWebcam == nullptr) {
+                spdlog::error("Could not open camera {}. Error: {}", SDL_GetCameraName(pendingCamera), SDL_GetError());
+            }
+            else if (!ResizeBuffersForCamera(newWebcam, gpu, &framePool, &frameResources, &cbufData, &isNV12Format)) {
+                spdlog::error("Keeping camera {} active.", currentCameraName);
+                SDL_CloseCamera(newWebcam);
+            }
+            else {
+                SDL_CloseCamera(webcam);
+                webcam = newWebcam;
+                currentCamera = pendingCamera;
+                currentCameraName = SDL_GetCameraName(currentCamera);
+                cameraYuvFrameSizeBytes = FrameResourcePool::YuvFrameSizeBytes(cbufData.frameWidth, cbufData.frameHeight);
+                const double switchMs = 1000.0 * double(SDL_GetPerformanceCounter() - switchStart) / double(SDL_GetPerformanceFrequency());
+                spdlog::info("Switched to camera {} in {:.3f} ms.", currentCameraName, switchMs);
+            }
+            pendingCamera = 0;
+        }
 
 #if 1
         [[maybe_unused]] Uint64 frameTimestamp;
@@ -528,9 +933,9 @@ int main(int argc, char** args) {
         }
 
         {
-            auto* txPointer = static_cast<Uint8*>(SDL_MapGPUTransferBuffer(gpu, txBuffer, false));
+            auto* txPointer = static_cast<Uint8*>(SDL_MapGPUTransferBuffer(gpu, frameResources.txBuffer, false));
             std::copy_n(static_cast<const Uint8*>(cpuCameraSurface->pixels), cameraYuvFrameSizeBytes, txPointer);
-            SDL_UnmapGPUTransferBuffer(gpu, txBuffer);
+            SDL_UnmapGPUTransferBuffer(gpu, frameResources.txBuffer);
         }
         SDL_ReleaseCameraFrame(webcam, cpuCameraSurface);
 #endif
@@ -557,14 +962,10 @@ int main(int argc, char** args) {
                 }
             }
             
-            // User selected a new camera
+            // User selected a new camera. The switch happens at the start of the next frame,
+            //  since this frame's camera image was already uploaded to the current resources.
             if (selectedCamera != -1 && cameras[selectedCamera] != currentCamera) {
-                SDL_CloseCamera(webcam);
-                webcam = SDL_OpenCamera(cameras[selectedCamera], nullptr);
-                currentCamera = cameras[selectedCamera];
-                currentCameraName = SDL_GetCameraName(currentCamera);
-                ResizeBuffersForCamera(webcam, gpu, &txBuffer, &rxBuffer, &gpuCameraFrame, &cameraTexture, &cbufData, &isNV12Format);
-                cameraYuvFrameSizeBytes = (3 * cbufData.frameWidth * cbufData.frameHeight) / 2;
+                pendingCamera = cameras[selectedCamera];
             }
             SDL_free(cameras);
 
@@ -584,6 +985,30 @@ int main(int argc, char** args) {
         ImGui::SliderFloat("Crunch Horizontal Factor", &crunchX, 0.1, 128, "%.2f", ImGuiSliderFlags_Logarithmic);
         ImGui::SliderFloat("Crunch Vertical Factor", &crunchY, 0.1, 128, "%.2f", ImGuiSliderFlags_Logarithmic);
 
+        // Every 8x8 block's DC term is its average, so we get a 1/8 scale preview for free.
+        static bool dcThumbnail = false;
+        static bool dcThumbnailQuantized = false;
+        static bool dcOnly = false;
+
+        ImGui::Checkbox("DC Thumbnail Output", &dcThumbnail);
+        ImGui::Checkbox("Quantize DC Thumbnail", &dcThumbnailQuantized);
+        ImGui::Checkbox("DC-Only Preview (skips AC terms)", &dcOnly);
+        const Uint32 thumbnailWidth = FrameResourcePool::DcThumbnailDim(cbufData.frameWidth);
+        const Uint32 thumbnailHeight = FrameResourcePool::DcThumbnailDim(cbufData.frameHeight);
+        if (dcThumbnail || dcOnly) {
+            ImGui::Text("Thumbnail: %ux%u", thumbnailWidth, thumbnailHeight);
+        }
+
+        cbufData.thumbnailFlags = 0
+            | (dcThumbnail          ? Uint32(ThumbnailFlags_Enable)    : 0)
+            | (dcThumbnailQuantized ? Uint32(ThumbnailFlags_Quantized) : 0)
+            | (dcOnly               ? Uint32(ThumbnailFlags_DcOnly)    : 0)
+        ;
+        // In DC-only mode the full resolution output is never written, so the thumbnail takes
+        //  over the whole window. Otherwise, it's shown picture-in-picture.
+        SDL_GPUTexture* displayTexture = dcOnly ? frameResources.dcThumbnailTexture : frameResources.cameraTexture;
+        const bool showThumbnailInset = dcThumbnail && !dcOnly;
+
         for (int row = 0; row < 8; ++row) {
             for (int col = 0; col < 8; ++col) {
                 const float quantVal = float((crunchY * row + crunchBase) * (crunchX * col + crunchBase)) / 255.0f;
@@ -593,8 +1018,14 @@ int main(int argc, char** args) {
         }
 
         char buttonText[64];
-        SDL_snprintf(buttonText, 64, "Save result to %s", imagePath);
-        saveTexture = ImGui::Button(buttonText);
+        if (!dcOnly) {
+            SDL_snprintf(buttonText, 64, "Save result to %s", imagePath);
+            saveTexture = ImGui::Button(buttonText);
+        }
+        if (dcThumbnail || dcOnly) {
+            SDL_snprintf(buttonText, 64, "Save thumbnail to %s", imagePath);
+            saveThumbnail = ImGui::Button(buttonText) && !saveTexture;
+        }
 
         ImGui::Render();
         ImDrawData* imGuiDrawData = ImGui::GetDrawData();
@@ -608,9 +1039,9 @@ int main(int argc, char** args) {
             SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(frameCmdBuf); {
                 SDL_GPUTransferBufferLocation cpuBufferLoc;
                     cpuBufferLoc.offset = 0;
-                    cpuBufferLoc.transfer_buffer = txBuffer;
+                    cpuBufferLoc.transfer_buffer = frameResources.txBuffer;
                 SDL_GPUBufferRegion gpuBufferLoc;
-                gpuBufferLoc.buffer = gpuCameraFrame;
+                gpuBufferLoc.buffer = frameResources.gpuCameraFrame;
                 gpuBufferLoc.offset = 0;
                 gpuBufferLoc.size = cameraYuvFrameSizeBytes;
                 SDL_UploadToGPUBuffer(copyPass, &cpuBufferLoc, &gpuBufferLoc, false);
@@ -618,29 +1049,43 @@ int main(int argc, char** args) {
                 if (saveTexture) {
                     SDL_GPUTextureTransferInfo texRxInfo = {0};
                         texRxInfo.offset = 0;
-                        texRxInfo.transfer_buffer = rxBuffer;
+                        texRxInfo.transfer_buffer = frameResources.rxBuffer;
                         texRxInfo.pixels_per_row = cbufData.frameWidth;
                         texRxInfo.rows_per_layer = cbufData.frameHeight;
                     SDL_GPUTextureRegion texRegion = {};
-                        texRegion.texture = cameraTexture;
+                        texRegion.texture = frameResources.cameraTexture;
                         texRegion.w = cbufData.frameWidth;
                         texRegion.h = cbufData.frameHeight;
                         texRegion.d = 1;
                     SDL_DownloadFromGPUTexture(copyPass, &texRegion, &texRxInfo);
                 }
+                if (saveThumbnail) {
+                    SDL_GPUTextureTransferInfo texRxInfo = {0};
+                        texRxInfo.offset = 0;
+                        texRxInfo.transfer_buffer = frameResources.rxBuffer;
+                        texRxInfo.pixels_per_row = thumbnailWidth;
+                        texRxInfo.rows_per_layer = thumbnailHeight;
+                    SDL_GPUTextureRegion texRegion = {};
+                        texRegion.texture = frameResources.dcThumbnailTexture;
+                        texRegion.w = thumbnailWidth;
+                        texRegion.h = thumbnailHeight;
+                        texRegion.d = 1;
+                    SDL_DownloadFromGPUTexture(copyPass, &texRegion, &texRxInfo);
+                }
             } SDL_EndGPUCopyPass(copyPass);
 
-            SDL_GPUStorageTextureReadWriteBinding outputTextureBinding = {0};
-                outputTextureBinding.texture = cameraTexture;
+            static constexpr Uint32 numWriteTextures = 2;
+            SDL_GPUStorageTextureReadWriteBinding outputTextureBindings[numWriteTextures] = {};
+                outputTextureBindings[0].texture = frameResources.cameraTexture;
+                outputTextureBindings[1].texture = frameResources.dcThumbnailTexture;
 
-            static constexpr Uint32 numWriteTextures = 1;
             static constexpr Uint32 numWriteBuffers = 0;
-            SDL_GPUComputePass* computePass = SDL_BeginGPUComputePass(frameCmdBuf, &outputTextureBinding, numWriteTextures, nullptr, numWriteBuffers);
+            SDL_GPUComputePass* computePass = SDL_BeginGPUComputePass(frameCmdBuf, outputTextureBindings, numWriteTextures, nullptr, numWriteBuffers);
             {
                 SDL_BindGPUComputePipeline(computePass, computePipe);
                 static constexpr Uint32 firstSlot = 0;
                 static constexpr Uint32 numReadBuffers = 1;
-                SDL_BindGPUComputeStorageBuffers(computePass, firstSlot, &gpuCameraFrame, numReadBuffers);
+                SDL_BindGPUComputeStorageBuffers(computePass, firstSlot, &frameResources.gpuCameraFrame, numReadBuffers);
                 static constexpr Uint32 constantBufferSlot = 0;
                 SDL_PushGPUComputeUniformData(frameCmdBuf, constantBufferSlot, &cbufData, sizeof(ConstantBufferData));
 
@@ -667,7 +1112,7 @@ int main(int argc, char** args) {
             const SDL_GPUTextureSamplerBinding samplerBinding = [&] {
                 SDL_GPUTextureSamplerBinding samplerBinding;
                 samplerBinding.sampler = sampler;
-                samplerBinding.texture = cameraTexture;
+                samplerBinding.texture = displayTexture;
 
                 return samplerBinding;
             }();
@@ -681,26 +1126,87 @@ int main(int argc, char** args) {
                 static constexpr Uint32 numSamplers = 1;
                 SDL_BindGPUFragmentSamplers(gfxPass, samplerSlot, &samplerBinding, numSamplers);
 
+                static constexpr Uint32 displayConstantBufferSlot = 0;
+                DisplayConstantBufferData displayCbufData = {};
+                displayCbufData.isDcThumbnail = dcOnly;
+                SDL_PushGPUFragmentUniformData(frameCmdBuf, displayConstantBufferSlot, &displayCbufData, sizeof(DisplayConstantBufferData));
+
                 static constexpr Uint32 numVerts = 4;
                 static constexpr Uint32 numInstances = 1;
                 static constexpr Uint32 firstVert = 0;
                 static constexpr Uint32 firstInstance = 0;
                 SDL_DrawGPUPrimitives(gfxPass, numVerts, numInstances, firstVert, firstInstance);
 
+                // Draw the thumbnail in the bottom-right corner, a quarter of the window wide.
+                if (showThumbnailInset && thumbnailWidth > 0) {
+                    const SDL_GPUTextureSamplerBinding thumbnailBinding = [&] {
+                        SDL_GPUTextureSamplerBinding thumbnailBinding;
+                        thumbnailBinding.sampler = sampler;
+                        thumbnailBinding.texture = frameResources.dcThumbnailTexture;
+
+                        return thumbnailBinding;
+                    }();
+                    SDL_BindGPUFragmentSamplers(gfxPass, samplerSlot, &thumbnailBinding, numSamplers);
+
+                    displayCbufData.isDcThumbnail = 1;
+                    SDL_PushGPUFragmentUniformData(frameCmdBuf, displayConstantBufferSlot, &displayCbufData, sizeof(DisplayConstantBufferData));
+
+                    static constexpr float insetMargin = 16.f;
+                    SDL_GPUViewport insetViewport = {};
+                    insetViewport.w = float(swapchainWidth) / 4.f;
+                    insetViewport.h = insetViewport.w * float(thumbnailHeight) / float(thumbnailWidth);
+                    insetViewport.x = float(swapchainWidth) - insetViewport.w - insetMargin;
+                    insetViewport.y = float(swapchainHeight) - insetViewport.h - insetMargin;
+                    insetViewport.min_depth = 0.f;
+                    insetViewport.max_depth = 1.f;
+                    SDL_SetGPUViewport(gfxPass, &insetViewport);
+                    SDL_DrawGPUPrimitives(gfxPass, numVerts, numInstances, firstVert, firstInstance);
+
+                    SDL_GPUViewport fullViewport = {};
+                    fullViewport.w = float(swapchainWidth);
+                    fullViewport.h = float(swapchainHeight);
+                    fullViewport.min_depth = 0.f;
+                    fullViewport.max_depth = 1.f;
+                    SDL_SetGPUViewport(gfxPass, &fullViewport);
+                }
+
                 // Finally, render ImGui.
                 ImGui_ImplSDLGPU3_RenderDrawData(imGuiDrawData, frameCmdBuf, gfxPass);
             } SDL_EndGPURenderPass(gfxPass);
         } frameFence = SDL_SubmitGPUCommandBufferAndAcquireFence(frameCmdBuf);
+
+        if (!loggedStartupTimings) {
+            spdlog::info("Startup timings (ms):\n"
+                "- GPU device: {:.2f}\n"
+                "- Window + swapchain: {:.2f}\n"
+                "- Camera open: {:.2f}\n"
+                "- Camera permission: {:.2f}\n"
+                "- Frame resources: {:.2f}\n"
+                "- ImGui: {:.2f}\n"
+                "- Pipelines: {:.2f} (worker), {:.2f} (waited on)\n"
+                "- First frame: {:.2f}\n"
+                "- Total to first processed frame: {:.2f}"
+                , deviceMs
+                , windowMs
+                , cameraOpenMs
+                , cameraPermissionMs
+                , frameResourcesMs
+                , imguiMs
+                , double(pipelineJob.elapsedNs) / 1e6
+                , pipelineWaitMs
+                , endStage()
+                , double(SDL_GetTicksNS() - startupBeginNs) / 1e6
+            );
+            loggedStartupTimings = true;
+        }
     }
 
     SDL_ReleaseGPUComputePipeline(gpu, computePipe);
     SDL_ReleaseGPUGraphicsPipeline(gpu, gfxPipe);
+    SDL_ReleaseGPUSampler(gpu, sampler);
 
-    SDL_ReleaseGPUTransferBuffer(gpu, txBuffer);
-    SDL_ReleaseGPUBuffer(gpu, gpuCameraFrame);
-    SDL_ReleaseGPUTexture(gpu, cameraTexture);
+    framePool.ReleaseAll(gpu);
 
-    // SDL_free(shaderCode);
     SDL_DestroyGPUDevice(gpu);
     SDL_Quit();
     return 0;
@@ -2,15 +2,24 @@
 //#define STORAGE_TYPE half
 #define STORAGE_TYPE float
 
+// Bits of ProcessingParams::thumbnailFlags - keep in sync with ThumbnailFlags in Main.cpp.
+//  dcThumbnail holds raw (Y, U, V, 1) DC coefficients, not colors; divide by 8 and
+//  convert from YUV to get an RGB preview.
+#define THUMBNAIL_ENABLE    1 // Write every 8x8 block's DC terms to dcThumbnail.
+#define THUMBNAIL_QUANTIZED 2 // Write the quantized DC terms instead of the exact ones.
+#define THUMBNAIL_DC_ONLY   4 // Only compute the thumbnail; skip AC terms and outputTexture.
+
 struct ProcessingParams {
     uint frameWidth;
     uint frameHeight;
     uint rowByteStride;
     uint uvByteOffset;
+    uint thumbnailFlags;
+    uint3 padding0;
 
     // Needs padding due to D3D's annoying constant buffer alignment rules.
     // Without this, the last few elements of the struct are dropped.
-    uint4 padding[15];
+    uint4 padding[14];
     
     // D3D is also annoying with arrays; you need to use <type>4 for
     //  constant buffers, or they get promoted automatically. Ugh...
@@ -20,6 +29,7 @@ struct ProcessingParams {
 
 ByteAddressBuffer inputRawYuvFrame      : register(t0, space0);
 RWTexture2D<float4> outputTexture       : register(u0, space1);
+RWTexture2D<float4> dcThumbnail         : register(u1, space1); // 1/8 of outputTexture, YUV DC terms
 ConstantBuffer<ProcessingParams> params : register(b0, space2);
 
 groupshared STORAGE_TYPE y[16][16];    // 512B
@@ -37,6 +47,15 @@ float QuantizeFloat(float x, float quantFactor, float invQuantFactor) {
     return (quantX * quantFactor);
 }
 
+// Writes the 2x2 thumbnail pixels covered by a 16x16 threadgroup: the 4 Y blocks'
+//  DC terms, each paired with the (shared) U and V DC terms.
+void WriteDcThumbnail(uint2 blockId, float4 dcY, float dcU, float dcV) {
+    dcThumbnail[(2 * blockId) + uint2(0, 0)] = float4(dcY[0], dcU, dcV, 1.0);
+    dcThumbnail[(2 * blockId) + uint2(1, 0)] = float4(dcY[1], dcU, dcV, 1.0);
+    dcThumbnail[(2 * blockId) + uint2(0, 1)] = float4(dcY[2], dcU, dcV, 1.0);
+    dcThumbnail[(2 * blockId) + uint2(1, 1)] = float4(dcY[3], dcU, dcV, 1.0);
+}
+
 int4 Uint32ToUVInt(uint x) {
     int4 bytes;
     bytes[0] = int((x >>  0) & 0xFF) - 0x80;
@@ -115,10 +134,75 @@ void CSMain(uint3 globalId : SV_DispatchThreadId
 
     GroupMemoryBarrierWithGroupSync();
 
+    // DC-only fast path: the DC term is just the block sum (times 1/8), so reduce
+    //  each block's columns, then its rows, and skip everything else.
+    //  thumbnailFlags is uniform across the dispatch, so the barrier below is safe.
+    if (params.thumbnailFlags & THUMBNAIL_DC_ONLY) {
+        if (localId.y == 0) {
+            float4 colSumY = .0f;
+            float colSumU = .0f;
+            float colSumV = .0f;
+            for (int row = 0; row != 8; ++row) {
+                const int col = localId.x;
+                colSumY[0] += y[row + 0][col + 0];
+                colSumY[1] += y[row + 0][col + 8];
+                colSumY[2] += y[row + 8][col + 0];
+                colSumY[3] += y[row + 8][col + 8];
+                colSumU += u[row][col];
+                colSumV += v[row][col];
+            }
+
+            dctY[0][localId.x + 0] = STORAGE_TYPE(colSumY[0]);
+            dctY[0][localId.x + 8] = STORAGE_TYPE(colSumY[1]);
+            dctY[8][localId.x + 0] = STORAGE_TYPE(colSumY[2]);
+            dctY[8][localId.x + 8] = STORAGE_TYPE(colSumY[3]);
+            dctU[0][localId.x] = STORAGE_TYPE(colSumU);
+            dctV[0][localId.x] = STORAGE_TYPE(colSumV);
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+
+        if (localId.x == 0 && localId.y == 0) {
+            float4 dcY = .0f;
+            float dcU = .0f;
+            float dcV = .0f;
+            for (int col = 0; col != 8; ++col) {
+                dcY[0] += dctY[0][col + 0];
+                dcY[1] += dctY[0][col + 8];
+                dcY[2] += dctY[8][col + 0];
+                dcY[3] += dctY[8][col + 8];
+                dcU += dctU[0][col];
+                dcV += dctV[0][col];
+            }
+            dcY *= (1.0f / 8.0f);
+            dcU *= (1.0f / 8.0f);
+            dcV *= (1.0f / 8.0f);
+
+            if (params.thumbnailFlags & THUMBNAIL_QUANTIZED) {
+                const float dcQuant    = params.quantTable   [0][0][0];
+                const float dcQuantInv = params.quantTableInv[0][0][0];
+                dcY[0] = QuantizeFloat(dcY[0], dcQuant, dcQuantInv);
+                dcY[1] = QuantizeFloat(dcY[1], dcQuant, dcQuantInv);
+                dcY[2] = QuantizeFloat(dcY[2], dcQuant, dcQuantInv);
+                dcY[3] = QuantizeFloat(dcY[3], dcQuant, dcQuantInv);
+                dcU = QuantizeFloat(dcU, dcQuant, dcQuantInv);
+                dcV = QuantizeFloat(dcV, dcQuant, dcQuantInv);
+            }
+
+            WriteDcThumbnail(blockId.xy, dcY, dcU, dcV);
+        }
+        return;
+    }
+
     // Stage 2 - DCT and destructive quantization
     float4 localDctY = .0f;
     float localDctU = .0f;
     float localDctV = .0f;
+
+    // Unquantized coefficients, kept around for the DC thumbnail.
+    float4 exactDctY;
+    float exactDctU;
+    float exactDctV;
 #if !defined(SEPARABLE_DCT)
     for (int row = 0; row != 8; ++row) {
         const float rowCoeff = dctCoeffs[localId.y][row];
@@ -133,6 +217,10 @@ void CSMain(uint3 globalId : SV_DispatchThreadId
         }
     }
 
+    exactDctY = localDctY;
+    exactDctU = localDctU;
+    exactDctV = localDctV;
+
     const float localQuant    = params.quantTable   [localId.y][localId.x / 4][localId.x % 4];
     const float localQuantInv = params.quantTableInv[localId.y][localId.x / 4][localId.x % 4];
     localDctY[0] = QuantizeFloat(localDctY[0], localQuant, localQuantInv);
@@ -190,6 +278,10 @@ void CSMain(uint3 globalId : SV_DispatchThreadId
         localDctV2 += dctV[row][col] * coeff;
     }
     
+    exactDctY = localDctY2;
+    exactDctU = localDctU2;
+    exactDctV = localDctV2;
+
     const float localQuant    = params.quantTable   [localId.y][localId.x / 4][localId.x % 4];
     const float localQuantInv = params.quantTableInv[localId.y][localId.x / 4][localId.x % 4];
     localDctY2[0] = QuantizeFloat(localDctY2[0], localQuant, localQuantInv);
@@ -212,6 +304,17 @@ void CSMain(uint3 globalId : SV_DispatchThreadId
 
     GroupMemoryBarrierWithGroupSync();
 
+    // Thread (0, 0) holds the DC terms of all 4 Y blocks and the U/V blocks.
+    if ((params.thumbnailFlags & THUMBNAIL_ENABLE) && localId.x == 0 && localId.y == 0) {
+        if (params.thumbnailFlags & THUMBNAIL_QUANTIZED) {
+            const float4 quantDcY = float4(dctY[0][0], dctY[0][8], dctY[8][0], dctY[8][8]);
+            WriteDcThumbnail(blockId.xy, quantDcY, dctU[0][0], dctV[0][0]);
+        }
+        else {
+            WriteDcThumbnail(blockId.xy, exactDctY, exactDctU, exactDctV);
+        }
+    }
+
     // Stage 3 - IDCT and write to texture
     float4 localY = .0f;
     float localU = .0f;
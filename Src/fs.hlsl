@@ -3,10 +3,30 @@ struct VertexOut {
     float2 tc : TEXCOORD0;
 };
 
+struct DisplayParams {
+    // Set when `image` is the DC thumbnail, which holds raw YUV DC terms instead of colors.
+    uint isDcThumbnail;
+    uint3 padding0;
+
+    // Same D3D constant buffer alignment rules as the compute shader's params.
+    uint4 padding[15];
+};
+
 Texture2D image   : register(t0, space2);
 SamplerState samp : register(s0, space2);
+ConstantBuffer<DisplayParams> displayParams : register(b0, space3);
 
 float4 FSMain(VertexOut vOut) : SV_Target0 {
     const float3 sampleTex = image.Sample(samp, vOut.tc).rgb;
+    if (displayParams.isDcThumbnail) {
+        // An orthonormal 8x8 DCT's DC term is 8 times the block average. Same
+        //  YUV to RGB conversion as cs.hlsl.
+        const float3x3 yuvToRgb = float3x3 (
+            1.0,    0.0,      1.402,
+            1.0,   -0.34414, -0.71414,
+            1.0,    1.772,    0.0
+        );
+        return float4(saturate(mul(yuvToRgb, sampleTex * (1.0f / 8.0f))), 1.0);
+    }
     return float4(sampleTex, 1.0);
 }
\ No newline at end of file